@@ -1,6 +1,9 @@
 #include "Allocator.h"
+#include "Parallel.h"
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -29,6 +32,142 @@ namespace
         return true;
     }
 
+    // below this many students the threads cost more than they save
+    constexpr std::size_t kParallelPhase1MinStudents = 4096;
+    constexpr std::size_t kParallelGrain = 512;
+
+    // Phase 1 in parallel with the same result as the sequential loop.
+    //
+    // Every unassigned student claims their next usable choice at once,
+    // counted with an atomic counter per project. Each project then keeps
+    // the earliest students (by position in students) up to its capacity
+    // and rolls the rest back onto their next choice, including students it
+    // was speculatively holding from an earlier round. Because every project
+    // ranks students by the same order this settles on exactly the seats the
+    // sequential walk hands out.
+    void AssignPreferencesParallel(
+        std::vector<Student>& students,
+        std::unordered_map<int, Project>& projects,
+        const std::vector<int>& projectIds)
+    {
+        const std::size_t projectCount = projectIds.size();
+
+        std::unordered_map<int, int> projectIndex;
+        projectIndex.reserve(projectCount);
+        for (std::size_t k = 0; k < projectCount; ++k) {
+            projectIndex[projectIds[k]] = static_cast<int>(k);
+        }
+
+        std::vector<int> capacity(projectCount);
+        for (std::size_t k = 0; k < projectCount; ++k) {
+            const Project& p = projects.at(projectIds[k]);
+            capacity[k] = std::max(0, p.multiplicity - p.assigned);
+        }
+
+        std::vector<std::size_t> nextChoice(students.size(), 0);
+        std::vector<int> target(students.size(), -1);
+        std::vector<int> ticket(students.size(), 0);
+
+        std::unique_ptr<std::atomic<int>[]> claims(new std::atomic<int>[projectCount]);
+        for (std::size_t k = 0; k < projectCount; ++k) claims[k].store(0);
+
+        std::vector<std::vector<int>> held(projectCount);
+        std::vector<int> touched(projectCount);
+        std::vector<int> offset(projectCount + 1);
+        std::vector<std::vector<int>> rejected(projectCount);
+
+        std::vector<int> proposers;
+        for (std::size_t i = 0; i < students.size(); ++i) {
+            if (students[i].assignedProject == -1)
+                proposers.push_back(static_cast<int>(i));
+        }
+
+        std::vector<int> bucket;
+        while (!proposers.empty()) {
+            std::atomic<int> touchedCount{ 0 };
+
+            // claim the next choice that is a real project
+            parallelFor(proposers.size(), kParallelGrain, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t n = begin; n < end; ++n) {
+                    const int i = proposers[n];
+                    const Student& s = students[i];
+                    target[i] = -1;
+
+                    while (nextChoice[i] < s.choices.size()) {
+                        auto it = projectIndex.find(s.choices[nextChoice[i]]);
+                        if (it != projectIndex.end()) {
+                            target[i] = it->second;
+                            break;
+                        }
+                        nextChoice[i]++;
+                    }
+
+                    if (target[i] == -1)
+                        continue;
+
+                    ticket[i] = claims[target[i]].fetch_add(1);
+                    if (ticket[i] == 0)
+                        touched[touchedCount.fetch_add(1)] = target[i];
+                }
+            });
+
+            const int touchedSize = touchedCount.load();
+            offset[0] = 0;
+            for (int t = 0; t < touchedSize; ++t) {
+                offset[t + 1] = offset[t] + claims[touched[t]].load();
+                claims[touched[t]].store(offset[t]);
+            }
+
+            bucket.assign(offset[touchedSize], -1);
+            parallelFor(proposers.size(), kParallelGrain, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t n = begin; n < end; ++n) {
+                    const int i = proposers[n];
+                    if (target[i] != -1)
+                        bucket[claims[target[i]].load() + ticket[i]] = i;
+                }
+            });
+
+            // resolve each project: earliest students keep the seats
+            parallelFor(static_cast<std::size_t>(touchedSize), 1, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t t = begin; t < end; ++t) {
+                    const int k = touched[t];
+                    std::vector<int>& h = held[k];
+
+                    auto first = bucket.begin() + offset[t];
+                    auto last = bucket.begin() + offset[t + 1];
+                    std::sort(first, last);
+
+                    const std::size_t mid = h.size();
+                    h.insert(h.end(), first, last);
+                    std::inplace_merge(h.begin(), h.begin() + mid, h.end());
+
+                    rejected[k].clear();
+                    if (h.size() > static_cast<std::size_t>(capacity[k])) {
+                        rejected[k].assign(h.begin() + capacity[k], h.end());
+                        h.resize(capacity[k]);
+                    }
+                    claims[k].store(0);
+                }
+            });
+
+            proposers.clear();
+            for (int t = 0; t < touchedSize; ++t) {
+                for (int i : rejected[touched[t]]) {
+                    nextChoice[i]++;
+                    proposers.push_back(i);
+                }
+            }
+        }
+
+        for (std::size_t k = 0; k < projectCount; ++k) {
+            Project& p = projects.at(projectIds[k]);
+            for (int i : held[k]) {
+                students[i].assignedProject = p.id;
+            }
+            p.assigned += static_cast<int>(held[k].size());
+        }
+    }
+
     bool EnsureStudentHasAnyProject(
         Student& s,
         std::unordered_map<int, Project>& projects,
@@ -95,13 +234,18 @@ void allocate(
 
     // Phase 1: Assign students to to projects by preference
 
-    for (auto& student : students) {
-        if (student.assignedProject != -1)
-            continue;
+    if (students.size() >= kParallelPhase1MinStudents && workerCount() > 1) {
+        AssignPreferencesParallel(students, projects, projectIds);
+    }
+    else {
+        for (auto& student : students) {
+            if (student.assignedProject != -1)
+                continue;
 
-        for (int pid : student.choices) {
-            if (AssignProjectIfNeeded(student, projects, pid))
-                break;
+            for (int pid : student.choices) {
+                if (AssignProjectIfNeeded(student, projects, pid))
+                    break;
+            }
         }
     }
 
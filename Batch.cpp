@@ -0,0 +1,196 @@
+#include "Batch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <unordered_map>
+
+#include "Allocator.h"
+#include "Checker.h"
+#include "Output.h"
+#include "Parallel.h"
+#include "Parser.h"
+#include "Score.h"
+#include "Stabilize.h"
+
+#include "Project.h"
+#include "Staff.h"
+#include "Student.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    std::vector<std::string> InputFiles(const std::string& dir)
+    {
+        const std::filesystem::path base(dir);
+        return {
+            (base / "staff.txt").string(),
+            (base / "projects.txt").string(),
+            (base / "students.txt").string(),
+        };
+    }
+
+    // total input size, a cheap stand in for how long an instance will take
+    std::uintmax_t InstanceSize(const std::string& dir)
+    {
+        std::uintmax_t total = 0;
+        for (const auto& file : InputFiles(dir)) {
+            std::error_code ec;
+            const std::uintmax_t size = std::filesystem::file_size(file, ec);
+            if (!ec) total += size;
+        }
+        return total;
+    }
+
+    BatchResult RunInstance(const std::string& dir, bool binary, bool verify)
+    {
+        BatchResult result;
+        result.dir = dir;
+
+        const std::vector<std::string> inputs = InputFiles(dir);
+        for (const auto& file : inputs) {
+            if (!std::filesystem::is_regular_file(file)) {
+                result.error = "missing " + file;
+                return result;
+            }
+        }
+
+        std::unordered_map<std::string, Staff> staff;
+        std::unordered_map<int, Project> projects;
+        std::vector<Student> students;
+
+        auto start = Clock::now();
+        parseStaff(inputs[0], staff);
+        parseProjects(inputs[1], projects);
+        parseStudents(inputs[2], students);
+        result.loadMs = MillisecondsSince(start);
+        result.students = students.size();
+
+        start = Clock::now();
+        allocate(students, projects, staff);
+        stabilize(students, projects, staff);
+        result.score = computeScore(students, projects, staff);
+        if (verify) result.valid = checkAllocation(students, projects, staff);
+        result.allocateMs = MillisecondsSince(start);
+
+        if (!result.valid) {
+            result.error = "failed verification, not written";
+            return result;
+        }
+
+        start = Clock::now();
+        std::string contents;
+        if (!formatAllocation(students, staff, inputs, result.score, binary, contents)) {
+            result.error = "failed to read input files for checksum";
+            return result;
+        }
+        writeOutput((std::filesystem::path(dir) / (binary ? "alloc.bin" : "alloc.txt")).string(), contents, binary);
+        result.writeMs = MillisecondsSince(start);
+
+        result.ok = true;
+        return result;
+    }
+}
+
+bool parseManifest(
+    const std::string& filename,
+    std::vector<std::string>& dirs)
+{
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to open manifest file\n";
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string dir;
+        if (iss >> dir) dirs.push_back(dir);
+    }
+    return true;
+}
+
+std::vector<BatchResult> runBatch(
+    const std::vector<std::string>& dirs,
+    bool binary,
+    bool verify)
+{
+    std::vector<BatchResult> results(dirs.size());
+
+    // biggest first so a large instance starts early instead of running
+    // alone at the end
+    std::vector<std::uintmax_t> sizes(dirs.size());
+    for (std::size_t n = 0; n < dirs.size(); ++n) {
+        sizes[n] = InstanceSize(dirs[n]);
+    }
+
+    std::vector<std::size_t> order(dirs.size());
+    std::iota(order.begin(), order.end(), std::size_t{ 0 });
+    std::stable_sort(order.begin(), order.end(),
+        [&](std::size_t a, std::size_t b) { return sizes[a] > sizes[b]; });
+
+    parallelForEachStealing(order.size(), [&](std::size_t k) {
+        const std::size_t n = order[k];
+        try {
+            results[n] = RunInstance(dirs[n], binary, verify);
+        }
+        catch (const std::exception& ex) {
+            results[n].dir = dirs[n];
+            results[n].ok = false;
+            results[n].error = ex.what();
+        }
+    });
+
+    return results;
+}
+
+std::string formatBatchSummary(
+    const std::vector<BatchResult>& results,
+    double wallMs,
+    bool verify)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+
+    std::size_t failed = 0;
+    double busyMs = 0;
+
+    for (const auto& r : results) {
+        out << r.dir;
+        if (!r.ok) {
+            ++failed;
+            out << " FAILED " << r.error << '\n';
+            continue;
+        }
+
+        out << " score " << r.score
+            << " students " << r.students
+            << " load " << r.loadMs << "ms"
+            << " allocate " << r.allocateMs << "ms"
+            << " write " << r.writeMs << "ms";
+        if (verify) out << (r.valid ? " VALID" : " INVALID");
+        out << '\n';
+
+        busyMs += r.loadMs + r.allocateMs + r.writeMs;
+    }
+
+    out << "instances " << results.size()
+        << " failed " << failed
+        << " busy " << busyMs << "ms"
+        << " wall " << wallMs << "ms\n";
+    return out.str();
+}
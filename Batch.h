@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct BatchResult {
+    std::string dir;
+
+    // false if the instance couldn't be read, written or failed verification
+    bool ok = false;
+    std::string error;
+
+    int score = 0;
+    bool valid = true;
+    std::size_t students = 0;
+
+    // milliseconds spent parsing, allocating (with stabilisation, scoring
+    // and verification) and writing
+    double loadMs = 0;
+    double allocateMs = 0;
+    double writeMs = 0;
+};
+
+// Manifest file, one instance directory per line. Each directory holds
+// staff.txt, projects.txt and students.txt. False if it can't be opened.
+bool parseManifest(
+    const std::string& filename,
+    std::vector<std::string>& dirs
+);
+
+// Allocates every instance and writes alloc.txt (alloc.bin if binary) into
+// its directory. Instances are independent and run on a work stealing pool,
+// largest first. Results are in manifest order.
+std::vector<BatchResult> runBatch(
+    const std::vector<std::string>& dirs,
+    bool binary,
+    bool verify
+);
+
+std::string formatBatchSummary(
+    const std::vector<BatchResult>& results,
+    double wallMs,
+    bool verify
+);
@@ -0,0 +1,108 @@
+#include "BinaryAlloc.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr std::uint32_t kVersion = 1;
+}
+
+std::vector<std::string> staffOrder(
+    const std::unordered_map<std::string, Staff>& staff)
+{
+    std::vector<std::string> ids;
+    ids.reserve(staff.size());
+    for (const auto& kv : staff) {
+        ids.push_back(kv.first);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+bool isBinaryAllocation(const char* data, std::size_t size)
+{
+    return size >= sizeof(kBinaryAllocMagic) &&
+        std::memcmp(data, kBinaryAllocMagic, sizeof(kBinaryAllocMagic)) == 0;
+}
+
+std::string formatBinaryAllocation(
+    const std::vector<Student>& students,
+    const std::unordered_map<std::string, Staff>& staff,
+    std::uint64_t checksum,
+    int score)
+{
+    const std::vector<std::string> order = staffOrder(staff);
+    std::unordered_map<std::string, std::uint32_t> supervisorIndex;
+    supervisorIndex.reserve(order.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        supervisorIndex[order[i]] = static_cast<std::uint32_t>(i);
+    }
+
+    BinaryAllocHeader header{};
+    std::memcpy(header.magic, kBinaryAllocMagic, sizeof(header.magic));
+    header.version = kVersion;
+    header.recordSize = sizeof(BinaryAllocRecord);
+    header.checksum = checksum;
+    header.count = students.size();
+    header.score = score;
+
+    std::string buffer(sizeof(header) + students.size() * sizeof(BinaryAllocRecord), '\0');
+    std::memcpy(&buffer[0], &header, sizeof(header));
+
+    char* out = &buffer[sizeof(header)];
+    for (std::size_t i = 0; i < students.size(); ++i) {
+        const Student& s = students[i];
+        auto it = supervisorIndex.find(s.assignedSupervisor);
+
+        BinaryAllocRecord rec;
+        rec.student = static_cast<std::uint32_t>(i);
+        rec.project = s.assignedProject;
+        rec.supervisor = it == supervisorIndex.end() ? kNoSupervisor : it->second;
+
+        std::memcpy(out, &rec, sizeof(rec));
+        out += sizeof(rec);
+    }
+    return buffer;
+}
+
+bool readBinaryAllocation(
+    const char* data,
+    std::size_t size,
+    std::uint64_t checksum,
+    const std::unordered_map<std::string, Staff>& staff,
+    std::vector<Student>& students)
+{
+    if (size < sizeof(BinaryAllocHeader) || !isBinaryAllocation(data, size))
+        return false;
+
+    // the file is mapped page aligned and the header is a multiple of the
+    // record alignment, so both can be used in place
+    const auto* header = reinterpret_cast<const BinaryAllocHeader*>(data);
+    if (header->version != kVersion || header->recordSize != sizeof(BinaryAllocRecord))
+        return false;
+    if (header->checksum != checksum)
+        return false;
+
+    // Must allocate every student exactly once
+    if (header->count != students.size() ||
+        size != sizeof(BinaryAllocHeader) + header->count * sizeof(BinaryAllocRecord))
+        return false;
+
+    const std::vector<std::string> order = staffOrder(staff);
+    const auto* records = reinterpret_cast<const BinaryAllocRecord*>(data + sizeof(BinaryAllocHeader));
+
+    std::vector<bool> seen(students.size(), false);
+    for (std::size_t n = 0; n < header->count; ++n) {
+        const BinaryAllocRecord& rec = records[n];
+        if (rec.student >= students.size() || seen[rec.student])
+            return false;
+        if (rec.supervisor >= order.size())
+            return false;
+
+        seen[rec.student] = true;
+        students[rec.student].assignedProject = rec.project;
+        students[rec.student].assignedSupervisor = order[rec.supervisor];
+    }
+    return true;
+}
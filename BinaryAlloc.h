@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Staff.h"
+#include "Student.h"
+
+// Binary allocation file, an alternative to the text format that can be
+// mapped and read in place. A header followed by one fixed width record per
+// student, all in the machine's byte order.
+//
+// student is the position of the student in students.txt and supervisor
+// the position of the supervisor in staff ids sorted by id. checksum is
+// contentChecksum of the staff, projects and students files the allocation
+// was made from.
+
+constexpr char kBinaryAllocMagic[8] = { 'S', 'A', 'L', 'L', 'O', 'C', 'B', '1' };
+constexpr std::uint32_t kNoSupervisor = 0xffffffffu;
+
+struct BinaryAllocHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint64_t checksum;
+    std::uint64_t count;
+    std::int64_t score;
+};
+
+struct BinaryAllocRecord {
+    std::uint32_t student;
+    std::int32_t project;
+    std::uint32_t supervisor;
+};
+
+static_assert(sizeof(BinaryAllocHeader) == 40, "header layout is part of the format");
+static_assert(sizeof(BinaryAllocRecord) == 12, "record layout is part of the format");
+
+// Staff ids in the order supervisor indices refer to
+std::vector<std::string> staffOrder(
+    const std::unordered_map<std::string, Staff>& staff
+);
+
+bool isBinaryAllocation(const char* data, std::size_t size);
+
+// The whole file as one buffer, students in their current order
+std::string formatBinaryAllocation(
+    const std::vector<Student>& students,
+    const std::unordered_map<std::string, Staff>& staff,
+    std::uint64_t checksum,
+    int score
+);
+
+// Fills the students' assignments straight from the records. False if the
+// file is truncated, was made from a different instance, or has a record
+// for an unknown or repeated student, an unknown supervisor or a missing
+// student.
+bool readBinaryAllocation(
+    const char* data,
+    std::size_t size,
+    std::uint64_t checksum,
+    const std::unordered_map<std::string, Staff>& staff,
+    std::vector<Student>& students
+);
@@ -0,0 +1,153 @@
+#include "Cache.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <unistd.h>
+
+namespace
+{
+    constexpr std::uint64_t kFnvOffset = 14695981039346656037ull;
+    constexpr std::uint64_t kFnvPrime = 1099511628211ull;
+
+    void HashBytes(std::uint64_t& h, const char* data, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i) {
+            h ^= static_cast<unsigned char>(data[i]);
+            h *= kFnvPrime;
+        }
+    }
+
+    // length first so "ab"+"c" and "a"+"bc" don't collide
+    void HashField(std::uint64_t& h, const std::string& field)
+    {
+        const std::uint64_t size = field.size();
+        char sizeBytes[sizeof(size)];
+        for (std::size_t i = 0; i < sizeof(size); ++i) {
+            sizeBytes[i] = static_cast<char>((size >> (8 * i)) & 0xff);
+        }
+        HashBytes(h, sizeBytes, sizeof(sizeBytes));
+        HashBytes(h, field.data(), field.size());
+    }
+
+    bool ReadWholeFile(const std::string& filename, std::string& contents)
+    {
+        std::ifstream in(filename, std::ios::binary);
+        if (!in) return false;
+
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        contents = ss.str();
+        return true;
+    }
+
+    std::filesystem::path EntryPath(const std::string& dir, const std::string& key)
+    {
+        return std::filesystem::path(dir) / (key + ".entry");
+    }
+}
+
+std::string cacheKey(
+    const std::string& engine,
+    const std::vector<std::string>& options,
+    const std::vector<std::string>& inputFiles)
+{
+    // two lanes with different seeds give a 128 bit key
+    std::uint64_t lanes[2] = { kFnvOffset, kFnvOffset ^ 0x9e3779b97f4a7c15ull };
+
+    auto hashField = [&](const std::string& field) {
+        for (auto& h : lanes) HashField(h, field);
+    };
+
+    hashField(engine);
+    hashField(std::to_string(options.size()));
+    for (const auto& opt : options) hashField(opt);
+
+    hashField(std::to_string(inputFiles.size()));
+    std::string contents;
+    for (const auto& file : inputFiles) {
+        if (!ReadWholeFile(file, contents)) return "";
+        hashField(contents);
+    }
+
+    static const char* digits = "0123456789abcdef";
+    std::string key;
+    for (std::uint64_t h : lanes) {
+        for (int shift = 60; shift >= 0; shift -= 4) {
+            key += digits[(h >> shift) & 0xf];
+        }
+    }
+    return key;
+}
+
+bool contentChecksum(
+    const std::vector<std::string>& files,
+    std::uint64_t& checksum)
+{
+    std::uint64_t h = kFnvOffset;
+    std::string contents;
+    for (const auto& file : files) {
+        if (!ReadWholeFile(file, contents)) return false;
+        HashField(h, contents);
+    }
+    checksum = h;
+    return true;
+}
+
+bool cacheLookup(
+    const std::string& dir,
+    const std::string& key,
+    std::string& contents)
+{
+    if (dir.empty() || key.empty()) return false;
+
+    // nothing stored is ever empty, so an empty entry is a broken one
+    return ReadWholeFile(EntryPath(dir, key).string(), contents) && !contents.empty();
+}
+
+void cacheStore(
+    const std::string& dir,
+    const std::string& key,
+    const std::string& contents)
+{
+    if (dir.empty() || key.empty()) return;
+
+    // a failed store only costs a recompute next time
+    static std::atomic<unsigned> counter{ 0 };
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+
+    std::ostringstream tmpName;
+    tmpName << key << ".tmp." << ::getpid() << '.'
+        << std::hash<std::thread::id>{}(std::this_thread::get_id()) << '.' << counter++;
+    const std::filesystem::path tmpPath = std::filesystem::path(dir) / tmpName.str();
+
+    {
+        std::ofstream out(tmpPath, std::ios::binary);
+        if (!out) {
+            std::cerr << "Failed to write cache entry in " << dir << '\n';
+            return;
+        }
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+
+        // small entries are still buffered here, only a failed flush or
+        // close shows the write didn't make it to disk
+        out.flush();
+        out.close();
+        if (!out) {
+            std::filesystem::remove(tmpPath, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tmpPath, EntryPath(dir, key), ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Key for a run: the tool and options used plus the contents of every input
+// file. Empty if an input can't be read, such runs are never cached.
+std::string cacheKey(
+    const std::string& engine,
+    const std::vector<std::string>& options,
+    const std::vector<std::string>& inputFiles
+);
+
+// True and fills contents if the cache directory has a non empty entry
+// for key
+bool cacheLookup(
+    const std::string& dir,
+    const std::string& key,
+    std::string& contents
+);
+
+// Stores contents under key. The entry is written to a temporary file and
+// renamed into place so concurrent runs never see a partial entry.
+void cacheStore(
+    const std::string& dir,
+    const std::string& key,
+    const std::string& contents
+);
+
+// 64 bit hash of the contents of some files, false if one can't be read.
+// Identifies an instance without keeping its files around.
+bool contentChecksum(
+    const std::vector<std::string>& files,
+    std::uint64_t& checksum
+);
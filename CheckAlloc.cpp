@@ -1,285 +1,237 @@
 #include <algorithm>
-#include <fstream>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
 #include <iostream>
-#include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
-#include <limits>
+#include "BinaryAlloc.h"
+#include "Cache.h"
+#include "Checker.h"
+#include "MappedFile.h"
+#include "Parallel.h"
 #include "Parser.h"
 #include "Project.h"
 #include "Staff.h"
 #include "Student.h"
 
-struct Assignment {
-    int projectId = -1;
-    std::string supervisorId;
-};
-
 namespace
 {
-    constexpr int kNoRank = std::numeric_limits<int>::max();
+    // bump when a change to the rules changes a verdict
+    const char* const kEngine = "CheckAlloc/1";
 
-    int StudentRankForProject(const Student& s, int pid)
-    {
-        for (int i = 0; i < static_cast<int>(s.choices.size()); ++i) {
-            if (s.choices[i] == pid) return i;
-        }
-        return kNoRank;
-    }
+    struct Options {
+        std::vector<std::string> files;
+        std::string sinceFile;
+        std::string cacheDir;
+    };
 
-    bool StudentStrictlyPrefers(const Student& s, int pidA, int pidB)
+    bool ParseArgs(int argc, char* argv[], Options& opts)
     {
-        const int ra = StudentRankForProject(s, pidA);
-        if (ra == kNoRank) return false; 
-        const int rb = StudentRankForProject(s, pidB);
-        return ra < rb;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--since" || arg == "--cache") {
+                if (++i == argc) return false;
+                (arg == "--since" ? opts.sinceFile : opts.cacheDir) = argv[i];
+            }
+            else {
+                opts.files.push_back(arg);
+            }
+        }
+        return opts.files.size() == 4;
     }
 
-    // 0 = own proposal, 1 = expertise, 2 = neither
-    int SupervisorCategoryForProject(const Staff& st, const Project& p)
-    {
-        if (p.proposer == st.id) return 0;
-        if (st.expertise.find(p.subject) != st.expertise.end()) return 1;
-        return 2;
-    }
+    using StudentIndex = std::unordered_map<std::string_view, int>;
 
-    bool SupervisorStrictlyPrefersProject(const Staff& st, const Project& better, const Project& worse)
+    bool IsSpace(char c)
     {
-        return SupervisorCategoryForProject(st, better) < SupervisorCategoryForProject(st, worse);
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
     }
 
-    bool IsAllDigits(const std::string& s)
+    bool IsAllDigits(std::string_view s)
     {
         return !s.empty() && std::all_of(s.begin(), s.end(),
             [](unsigned char c) { return std::isdigit(c) != 0; });
     }
-}
 
-int main(int argc, char* argv[])
-{
-    if (argc != 5) {
-        std::cerr << "Usage: ./CheckAlloc staff.txt projects.txt students.txt alloc.txt\n";
-        return 1;
-    }
-
-    std::unordered_map<std::string, Staff> staff;
-    std::unordered_map<int, Project> projects;
-    std::vector<Student> students;
-
-    parseStaff(argv[1], staff);
-    parseProjects(argv[2], projects);
-    parseStudents(argv[3], students);
-
-    // studentId -> Student*
-    std::unordered_map<std::string, const Student*> studentsById;
-    studentsById.reserve(students.size());
-    for (const auto& s : students) {
-        studentsById[s.id] = &s;
-    }
-
-    std::ifstream in(argv[4]);
-    if (!in) {
-        std::cout << "INVALID\n";
-        return 0;
-    }
-
-    // Read out file
-    std::unordered_map<std::string, Assignment> alloc;
-    alloc.reserve(students.size());
-
-    std::unordered_set<std::string> seenStudents;
-    seenStudents.reserve(students.size());
-
-    std::string line;
-    while (std::getline(in, line)) {
-        if (line.empty()) continue;
-
-        std::istringstream iss(line);
-
-        std::string tok1;
-        if (!(iss >> tok1)) continue;
-
-        // If the line is exactly a single integer token, treat as score line and ignore.
-        std::string extra;
-        if (IsAllDigits(tok1) && !(iss >> extra)) {
-            continue;
+    // Splits a line into up to max whitespace separated tokens, returns
+    // how many there were (capped at max)
+    int Tokenize(std::string_view line, std::string_view* tokens, int max)
+    {
+        int n = 0;
+        std::size_t i = 0;
+        while (n < max) {
+            while (i < line.size() && IsSpace(line[i])) ++i;
+            if (i == line.size()) break;
+
+            const std::size_t start = i;
+            while (i < line.size() && !IsSpace(line[i])) ++i;
+            tokens[n++] = line.substr(start, i - start);
         }
+        return n;
+    }
+
+    constexpr std::size_t kReadChunkBytes = 1 << 20;
+
+    // Reads an allocation file into the students' assignedProject and
+    // assignedSupervisor. False if it can't be opened, is malformed, names an
+    // unknown student, lists a student twice or leaves one out.
+    //
+    // Binary files are read in place and must have been made from
+    // instanceFiles. Text files are split into chunks on line boundaries
+    // which are parsed in parallel, a shared bitmap catches students listed
+    // twice.
+    bool ReadAllocation(
+        const std::string& filename,
+        const std::vector<std::string>& instanceFiles,
+        const std::unordered_map<std::string, Staff>& staff,
+        const StudentIndex& studentIndex,
+        std::vector<Student>& students)
+    {
+        MappedFile file(filename);
+        if (!file.isOpen()) return false;
 
-        // Otherwise must be: sid pid sup
-        std::string sid = tok1;
-        int pid = -1;
-        std::string sup;
-
-        if (!(iss >> pid >> sup)) {
-            std::cout << "INVALID\n";
-            return 0;
+        if (isBinaryAllocation(file.data(), file.size())) {
+            std::uint64_t checksum = 0;
+            return contentChecksum(instanceFiles, checksum) &&
+                readBinaryAllocation(file.data(), file.size(), checksum, staff, students);
         }
 
-        if (studentsById.find(sid) == studentsById.end()) {
-            std::cout << "INVALID\n";
-            return 0;
-        }
-        if (!seenStudents.insert(sid).second) {
-            std::cout << "INVALID\n";
-            return 0;
-        }
+        const std::string_view text(file.data(), file.size());
 
-        alloc[sid] = { pid, sup };
-    }
+        const std::size_t studentCount = students.size();
+        std::vector<std::atomic<std::uint64_t>> seen((studentCount + 63) / 64);
+        for (auto& word : seen) word.store(0);
 
-    // Must allocate every student exactly once
-    if (alloc.size() != students.size()) {
-        std::cout << "INVALID\n";
-        return 0;
-    }
+        std::atomic<std::size_t> seenCount{ 0 };
+        std::atomic<bool> ok{ true };
 
-    // LEGALITY CHECKS
-    std::unordered_map<int, int> projectCount;
-    std::unordered_map<std::string, int> staffCount;
-    projectCount.reserve(projects.size());
-    staffCount.reserve(staff.size());
+        // chunk boundaries, each one just after a newline
+        std::vector<std::size_t> bounds{ 0 };
+        while (bounds.back() < text.size()) {
+            std::size_t next = bounds.back() + kReadChunkBytes;
+            if (next >= text.size()) {
+                next = text.size();
+            }
+            else {
+                const std::size_t nl = text.find('\n', next);
+                next = nl == std::string_view::npos ? text.size() : nl + 1;
+            }
+            bounds.push_back(next);
+        }
 
-    for (const auto& kv : alloc) {
-        const Assignment& a = kv.second;
+        parallelFor(bounds.size() - 1, 1, [&](std::size_t begin, std::size_t end) {
+            std::size_t pos = bounds[begin];
+            const std::size_t stop = bounds[end];
+            std::size_t count = 0;
+
+            while (pos < stop && ok.load(std::memory_order_relaxed)) {
+                std::size_t nl = text.find('\n', pos);
+                if (nl == std::string_view::npos || nl > stop) nl = stop;
+                const std::string_view line = text.substr(pos, nl - pos);
+                pos = nl + 1;
+
+                std::string_view tok[3];
+                const int n = Tokenize(line, tok, 3);
+                if (n == 0) continue;
+
+                // If the line is exactly a single integer token, treat as score line and ignore.
+                if (n == 1 && IsAllDigits(tok[0])) continue;
+
+                // Otherwise must be: sid pid sup
+                int pid = -1;
+                const auto res = std::from_chars(tok[1].data(), tok[1].data() + tok[1].size(), pid);
+                if (n < 3 || res.ec != std::errc() || res.ptr != tok[1].data() + tok[1].size()) {
+                    ok = false;
+                    break;
+                }
 
-        if (projects.find(a.projectId) == projects.end()) {
-            std::cout << "INVALID\n";
-            return 0;
-        }
-        if (staff.find(a.supervisorId) == staff.end()) {
-            std::cout << "INVALID\n";
-            return 0;
-        }
+                auto it = studentIndex.find(tok[0]);
+                if (it == studentIndex.end()) {
+                    ok = false;
+                    break;
+                }
 
-        projectCount[a.projectId]++;
-        staffCount[a.supervisorId]++;
-    }
+                const std::size_t idx = static_cast<std::size_t>(it->second);
+                const std::uint64_t bit = std::uint64_t{ 1 } << (idx % 64);
+                if (seen[idx / 64].fetch_or(bit) & bit) {
+                    ok = false;
+                    break;
+                }
 
-    for (const auto& kv : projectCount) {
-        const Project& p = projects.at(kv.first);
-        if (kv.second > p.multiplicity) {
-            std::cout << "INVALID\n";
-            return 0;
-        }
-    }
+                students[idx].assignedProject = pid;
+                students[idx].assignedSupervisor = std::string(tok[2]);
+                ++count;
+            }
 
-    for (const auto& kv : staffCount) {
-        const Staff& st = staff.at(kv.first);
-        if (kv.second > st.load) {
-            std::cout << "INVALID\n";
-            return 0;
-        }
-    }
+            seenCount += count;
+        });
 
-    auto isAvailable = [&](int pid) -> bool {
-        auto pit = projects.find(pid);
-        if (pit == projects.end()) return false;
-        const int used = projectCount.count(pid) ? projectCount.at(pid) : 0;
-        return used < pit->second.multiplicity;
-        };
-
-    // map of students supervised by each supervisor
-    std::unordered_map<std::string, std::vector<std::string>> superviseesByStaff;
-    superviseesByStaff.reserve(staff.size());
-    for (const auto& kv : alloc) {
-        superviseesByStaff[kv.second.supervisorId].push_back(kv.first);
+        // Must allocate every student exactly once
+        return ok && seenCount == studentCount;
     }
+}
 
-    // STABILITY RULE 1
-    for (const auto& s : students) {
-        const Assignment& a = alloc.at(s.id);
-        const int currentPid = a.projectId;
-        const int curRank = StudentRankForProject(s, currentPid);
-
-        for (int i = 0; i < static_cast<int>(s.choices.size()); ++i) {
-            if (i >= curRank) break;
-            if (isAvailable(s.choices[i])) {
-                std::cout << "INVALID\n";
-                return 0;
-            }
-        }
+int main(int argc, char* argv[])
+{
+    Options opts;
+    if (!ParseArgs(argc, argv, opts)) {
+        std::cerr << "Usage: ./CheckAlloc staff.txt projects.txt students.txt alloc.txt [--since valid_alloc.txt] [--cache dir]\n";
+        return 1;
     }
 
-    // STABILITY RULE 2
-    std::vector<std::string> ids;
-    ids.reserve(students.size());
-    for (const auto& s : students) ids.push_back(s.id);
-
-    for (std::size_t i = 0; i < ids.size(); ++i) {
-        const Student& A = *studentsById.at(ids[i]);
-        const int pidA = alloc.at(A.id).projectId;
-
-        for (std::size_t j = i + 1; j < ids.size(); ++j) {
-            const Student& B = *studentsById.at(ids[j]);
-            const int pidB = alloc.at(B.id).projectId;
+    // the verdict only depends on the input files, reuse it if we have it
+    std::string key;
+    if (!opts.cacheDir.empty()) {
+        std::vector<std::string> inputs = opts.files;
+        if (!opts.sinceFile.empty()) inputs.push_back(opts.sinceFile);
+        key = cacheKey(kEngine, { opts.sinceFile.empty() ? "full" : "since" }, inputs);
 
-            if (StudentStrictlyPrefers(A, pidB, pidA) &&
-                StudentStrictlyPrefers(B, pidA, pidB)) {
-                std::cout << "INVALID\n";
-                return 0;
-            }
+        std::string cached;
+        if (cacheLookup(opts.cacheDir, key, cached)) {
+            std::cout << cached;
+            return 0;
         }
     }
 
-    // STABILITY RULE 3
-    for (const auto& s : students) {
-        const Assignment& a = alloc.at(s.id);
-        const int studentRank = StudentRankForProject(s, a.projectId);
-        if (studentRank != kNoRank) continue; // only when student didn't choose it
-
-        const Staff& st = staff.at(a.supervisorId);
-        const Project& curProj = projects.at(a.projectId);
-
-        for (const auto& pkv : projects) {
-            const Project& candidate = pkv.second;
-            if (!isAvailable(candidate.id)) continue;
+    std::unordered_map<std::string, Staff> staff;
+    std::unordered_map<int, Project> projects;
+    std::vector<Student> students;
 
-            if (SupervisorStrictlyPrefersProject(st, candidate, curProj)) {
-                std::cout << "INVALID\n";
-                return 0;
+    parseStaff(opts.files[0], staff);
+    parseProjects(opts.files[1], projects);
+    parseStudents(opts.files[2], students);
+
+    // studentId -> position in students
+    StudentIndex studentIndex;
+    studentIndex.reserve(students.size());
+    for (std::size_t i = 0; i < students.size(); ++i) {
+        studentIndex.emplace(students[i].id, static_cast<int>(i));
+    }
+
+    const std::vector<std::string> instanceFiles(opts.files.begin(), opts.files.begin() + 3);
+
+    bool valid = false;
+    if (ReadAllocation(opts.files[3], instanceFiles, staff, studentIndex, students)) {
+        // the previous allocation is trusted to be VALID, if it can't be read
+        // fall back to checking everything
+        bool checked = false;
+        if (!opts.sinceFile.empty()) {
+            // a successful read overwrites every student's assignment
+            std::vector<Student> previous = students;
+            if (ReadAllocation(opts.sinceFile, instanceFiles, staff, studentIndex, previous)) {
+                valid = checkAllocationSince(students, previous, projects, staff);
+                checked = true;
             }
         }
+        if (!checked) valid = checkAllocation(students, projects, staff);
     }
 
-    // STABILITY RULE 4
-    
-    std::vector<std::string> supervisingStaff;
-    supervisingStaff.reserve(superviseesByStaff.size());
-    for (const auto& kv : superviseesByStaff) {
-        if (!kv.second.empty()) supervisingStaff.push_back(kv.first);
-    }
-
-    for (std::size_t i = 0; i < supervisingStaff.size(); ++i) {
-        const std::string& supAId = supervisingStaff[i];
-        const Staff& supA = staff.at(supAId);
-        const auto& supAStudents = superviseesByStaff.at(supAId);
-
-        for (std::size_t j = i + 1; j < supervisingStaff.size(); ++j) {
-            const std::string& supBId = supervisingStaff[j];
-            const Staff& supB = staff.at(supBId);
-            const auto& supBStudents = superviseesByStaff.at(supBId);
-
-            for (const auto& studAId : supAStudents) {
-                const Project& projA = projects.at(alloc.at(studAId).projectId);
-
-                for (const auto& studBId : supBStudents) {
-                    const Project& projB = projects.at(alloc.at(studBId).projectId);
+    const std::string verdict = valid ? "VALID\n" : "INVALID\n";
+    std::cout << verdict;
 
-                    const bool AStrictlyHappier = SupervisorStrictlyPrefersProject(supA, projB, projA);
-                    const bool BStrictlyHappier = SupervisorStrictlyPrefersProject(supB, projA, projB);
-
-                    if (AStrictlyHappier && BStrictlyHappier) {
-                        std::cout << "INVALID\n";
-                        return 0;
-                    }
-                }
-            }
-        }
-    }
-    //If nothing is INVALID
-    std::cout << "VALID\n";
+    cacheStore(opts.cacheDir, key, verdict);
     return 0;
 }
-    
\ No newline at end of file
@@ -0,0 +1,303 @@
+#include "Checker.h"
+
+#include <string>
+#include <unordered_set>
+
+namespace
+{
+    bool StudentStrictlyPrefers(const Student& s, int pidA, int pidB)
+    {
+        const int ra = studentRankForProject(s, pidA);
+        if (ra == kNoRank) return false;
+        const int rb = studentRankForProject(s, pidB);
+        return ra < rb;
+    }
+
+    bool SupervisorStrictlyPrefersProject(const Staff& st, const Project& better, const Project& worse)
+    {
+        return supervisorCategoryForProject(st, better) < supervisorCategoryForProject(st, worse);
+    }
+
+    void CountAssignments(
+        const std::vector<Student>& students,
+        std::unordered_map<int, int>& projectCount,
+        std::unordered_map<std::string, int>& staffCount)
+    {
+        projectCount.reserve(students.size());
+        staffCount.reserve(students.size());
+        for (const auto& s : students) {
+            projectCount[s.assignedProject]++;
+            staffCount[s.assignedSupervisor]++;
+        }
+    }
+
+    bool KnownIds(
+        const Student& s,
+        const std::unordered_map<int, Project>& projects,
+        const std::unordered_map<std::string, Staff>& staff)
+    {
+        return projects.find(s.assignedProject) != projects.end() &&
+            staff.find(s.assignedSupervisor) != staff.end();
+    }
+
+    bool ProjectWithinCapacity(
+        int pid,
+        const std::unordered_map<int, Project>& projects,
+        const std::unordered_map<int, int>& projectCount)
+    {
+        auto cit = projectCount.find(pid);
+        return cit == projectCount.end() || cit->second <= projects.at(pid).multiplicity;
+    }
+
+    bool StaffWithinCapacity(
+        const std::string& sid,
+        const std::unordered_map<std::string, Staff>& staff,
+        const std::unordered_map<std::string, int>& staffCount)
+    {
+        auto cit = staffCount.find(sid);
+        return cit == staffCount.end() || cit->second <= staff.at(sid).load;
+    }
+
+    bool IsAvailable(
+        int pid,
+        const std::unordered_map<int, Project>& projects,
+        const std::unordered_map<int, int>& projectCount)
+    {
+        auto pit = projects.find(pid);
+        if (pit == projects.end()) return false;
+        auto cit = projectCount.find(pid);
+        const int used = cit == projectCount.end() ? 0 : cit->second;
+        return used < pit->second.multiplicity;
+    }
+
+    // Rule 1: a project the student ranked above their own still has room
+    bool BreaksRule1(
+        const Student& s,
+        const std::unordered_map<int, Project>& projects,
+        const std::unordered_map<int, int>& projectCount,
+        const std::unordered_set<int>* onlyProjects)
+    {
+        const int curRank = studentRankForProject(s, s.assignedProject);
+
+        for (int i = 0; i < static_cast<int>(s.choices.size()); ++i) {
+            if (i >= curRank) break;
+            if (onlyProjects && onlyProjects->count(s.choices[i]) == 0) continue;
+            if (IsAvailable(s.choices[i], projects, projectCount)) return true;
+        }
+        return false;
+    }
+
+    // Rule 2: both students prefer each other's project
+    bool BreaksRule2(const Student& A, const Student& B)
+    {
+        return StudentStrictlyPrefers(A, B.assignedProject, A.assignedProject) &&
+            StudentStrictlyPrefers(B, A.assignedProject, B.assignedProject);
+    }
+
+    // Rule 3: student didn't choose their project and the supervisor would
+    // rather supervise one that still has room
+    bool BreaksRule3(
+        const Student& s,
+        const std::unordered_map<int, Project>& projects,
+        const std::unordered_map<std::string, Staff>& staff,
+        const std::unordered_map<int, int>& projectCount,
+        const std::unordered_set<int>* onlyProjects)
+    {
+        if (studentRankForProject(s, s.assignedProject) != kNoRank) return false;
+
+        const Staff& st = staff.at(s.assignedSupervisor);
+        const Project& curProj = projects.at(s.assignedProject);
+
+        if (onlyProjects) {
+            for (int pid : *onlyProjects) {
+                if (!IsAvailable(pid, projects, projectCount)) continue;
+                if (SupervisorStrictlyPrefersProject(st, projects.at(pid), curProj)) return true;
+            }
+            return false;
+        }
+
+        for (const auto& pkv : projects) {
+            const Project& candidate = pkv.second;
+            if (!IsAvailable(candidate.id, projects, projectCount)) continue;
+
+            if (SupervisorStrictlyPrefersProject(st, candidate, curProj)) return true;
+        }
+        return false;
+    }
+
+    // Rule 4: two supervisors both prefer each other's student's project
+    bool BreaksRule4(const Staff& supA, const Project& projA, const Staff& supB, const Project& projB)
+    {
+        return SupervisorStrictlyPrefersProject(supA, projB, projA) &&
+            SupervisorStrictlyPrefersProject(supB, projA, projB);
+    }
+}
+
+int studentRankForProject(const Student& s, int pid)
+{
+    for (int i = 0; i < static_cast<int>(s.choices.size()); ++i) {
+        if (s.choices[i] == pid) return i;
+    }
+    return kNoRank;
+}
+
+int supervisorCategoryForProject(const Staff& st, const Project& p)
+{
+    if (p.proposer == st.id) return 0;
+    if (st.expertise.find(p.subject) != st.expertise.end()) return 1;
+    return 2;
+}
+
+bool checkAllocation(
+    const std::vector<Student>& students,
+    const std::unordered_map<int, Project>& projects,
+    const std::unordered_map<std::string, Staff>& staff)
+{
+    // LEGALITY CHECKS
+    for (const auto& s : students) {
+        if (!KnownIds(s, projects, staff)) return false;
+    }
+
+    std::unordered_map<int, int> projectCount;
+    std::unordered_map<std::string, int> staffCount;
+    CountAssignments(students, projectCount, staffCount);
+
+    for (const auto& kv : projectCount) {
+        if (!ProjectWithinCapacity(kv.first, projects, projectCount)) return false;
+    }
+    for (const auto& kv : staffCount) {
+        if (!StaffWithinCapacity(kv.first, staff, staffCount)) return false;
+    }
+
+    // STABILITY RULE 1
+    for (const auto& s : students) {
+        if (BreaksRule1(s, projects, projectCount, nullptr)) return false;
+    }
+
+    // STABILITY RULE 2
+    for (std::size_t i = 0; i < students.size(); ++i) {
+        for (std::size_t j = i + 1; j < students.size(); ++j) {
+            if (BreaksRule2(students[i], students[j])) return false;
+        }
+    }
+
+    // STABILITY RULE 3
+    for (const auto& s : students) {
+        if (BreaksRule3(s, projects, staff, projectCount, nullptr)) return false;
+    }
+
+    // STABILITY RULE 4
+
+    // map of students supervised by each supervisor
+    std::unordered_map<std::string, std::vector<const Student*>> superviseesByStaff;
+    superviseesByStaff.reserve(staff.size());
+    for (const auto& s : students) {
+        superviseesByStaff[s.assignedSupervisor].push_back(&s);
+    }
+
+    std::vector<std::string> supervisingStaff;
+    supervisingStaff.reserve(superviseesByStaff.size());
+    for (const auto& kv : superviseesByStaff) {
+        if (!kv.second.empty()) supervisingStaff.push_back(kv.first);
+    }
+
+    for (std::size_t i = 0; i < supervisingStaff.size(); ++i) {
+        const std::string& supAId = supervisingStaff[i];
+        const Staff& supA = staff.at(supAId);
+        const auto& supAStudents = superviseesByStaff.at(supAId);
+
+        for (std::size_t j = i + 1; j < supervisingStaff.size(); ++j) {
+            const std::string& supBId = supervisingStaff[j];
+            const Staff& supB = staff.at(supBId);
+            const auto& supBStudents = superviseesByStaff.at(supBId);
+
+            for (const Student* studA : supAStudents) {
+                const Project& projA = projects.at(studA->assignedProject);
+
+                for (const Student* studB : supBStudents) {
+                    const Project& projB = projects.at(studB->assignedProject);
+                    if (BreaksRule4(supA, projA, supB, projB)) return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool checkAllocationSince(
+    const std::vector<Student>& students,
+    const std::vector<Student>& previous,
+    const std::unordered_map<int, Project>& projects,
+    const std::unordered_map<std::string, Staff>& staff)
+{
+    std::vector<std::size_t> changed;
+    std::vector<char> isChanged(students.size(), 0);
+    std::unordered_set<int> vacatedProjects;
+
+    for (std::size_t i = 0; i < students.size(); ++i) {
+        const Student& now = students[i];
+        const Student& before = previous[i];
+        if (now.assignedProject == before.assignedProject &&
+            now.assignedSupervisor == before.assignedSupervisor)
+            continue;
+
+        changed.push_back(i);
+        isChanged[i] = 1;
+        if (now.assignedProject != before.assignedProject)
+            vacatedProjects.insert(before.assignedProject);
+    }
+
+    if (changed.empty()) return true;
+
+    // LEGALITY CHECKS, only the changed students can have pushed a
+    // project or supervisor over capacity
+    for (const auto& s : students) {
+        if (!KnownIds(s, projects, staff)) return false;
+    }
+
+    std::unordered_map<int, int> projectCount;
+    std::unordered_map<std::string, int> staffCount;
+    CountAssignments(students, projectCount, staffCount);
+
+    for (std::size_t c : changed) {
+        const Student& s = students[c];
+        if (!ProjectWithinCapacity(s.assignedProject, projects, projectCount)) return false;
+        if (!StaffWithinCapacity(s.assignedSupervisor, staff, staffCount)) return false;
+    }
+
+    // projects that had no room before and might now
+    std::unordered_set<int> freedProjects;
+    for (int pid : vacatedProjects) {
+        if (IsAvailable(pid, projects, projectCount)) freedProjects.insert(pid);
+    }
+
+    // STABILITY RULES 1 and 3
+    for (std::size_t i = 0; i < students.size(); ++i) {
+        if (!isChanged[i] && freedProjects.empty()) continue;
+
+        const std::unordered_set<int>* only = isChanged[i] ? nullptr : &freedProjects;
+        if (BreaksRule1(students[i], projects, projectCount, only)) return false;
+        if (BreaksRule3(students[i], projects, staff, projectCount, only)) return false;
+    }
+
+    // STABILITY RULES 2 and 4, every pair with at least one changed student
+    for (std::size_t c : changed) {
+        const Student& sc = students[c];
+        const Staff& supC = staff.at(sc.assignedSupervisor);
+        const Project& projC = projects.at(sc.assignedProject);
+
+        for (std::size_t o = 0; o < students.size(); ++o) {
+            if (o == c) continue;
+            const Student& so = students[o];
+
+            if (BreaksRule2(sc, so)) return false;
+
+            if (so.assignedSupervisor == sc.assignedSupervisor) continue;
+            if (BreaksRule4(supC, projC, staff.at(so.assignedSupervisor), projects.at(so.assignedProject)))
+                return false;
+        }
+    }
+
+    return true;
+}
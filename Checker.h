@@ -0,0 +1,36 @@
+#pragma once
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include "Staff.h"
+#include "Project.h"
+#include "Student.h"
+
+// Rank of a project in a student's choices, 0 is their first choice.
+// kNoRank if they didn't choose it.
+constexpr int kNoRank = std::numeric_limits<int>::max();
+
+int studentRankForProject(const Student& s, int pid);
+
+// 0 = own proposal, 1 = expertise, 2 = neither
+int supervisorCategoryForProject(const Staff& st, const Project& p);
+
+// True if every student's assignedProject and assignedSupervisor are known
+// and within capacity and none of the stability rules fail. Only reads the
+// assignments on students, the assigned counters on projects and staff are
+// not trusted.
+bool checkAllocation(
+    const std::vector<Student>& students,
+    const std::unordered_map<int, Project>& projects,
+    const std::unordered_map<std::string, Staff>& staff
+);
+
+// Same verdict as checkAllocation for an allocation edited from one that
+// already passed. previous holds the old assignments in the same order as
+// students, only the rules an edit could have broken are checked again.
+bool checkAllocationSince(
+    const std::vector<Student>& students,
+    const std::vector<Student>& previous,
+    const std::unordered_map<int, Project>& projects,
+    const std::unordered_map<std::string, Staff>& staff
+);
@@ -0,0 +1,42 @@
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filename)
+{
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return;
+    }
+
+    length = static_cast<std::size_t>(st.st_size);
+
+    // an empty file can't be mapped but is still a valid file
+    if (length > 0) {
+        void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return;
+        }
+        ::madvise(p, length, MADV_SEQUENTIAL);
+        bytes = static_cast<const char*>(p);
+    }
+
+    ::close(fd);
+    open = true;
+}
+
+MappedFile::~MappedFile()
+{
+    if (bytes)
+        ::munmap(const_cast<char*>(bytes), length);
+}
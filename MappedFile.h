@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read only view of a whole file mapped into memory
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // false if the file couldn't be opened or mapped
+    bool isOpen() const { return open; }
+
+    const char* data() const { return bytes; }
+    std::size_t size() const { return length; }
+
+private:
+    const char* bytes = nullptr;
+    std::size_t length = 0;
+    bool open = false;
+};
@@ -0,0 +1,54 @@
+#include "Output.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "BinaryAlloc.h"
+#include "Cache.h"
+
+bool formatAllocation(
+    std::vector<Student>& students,
+    const std::unordered_map<std::string, Staff>& staff,
+    const std::vector<std::string>& inputFiles,
+    int score,
+    bool binary,
+    std::string& contents)
+{
+    if (binary) {
+        // records refer to students by position, no sort needed
+        std::uint64_t checksum = 0;
+        if (!contentChecksum(inputFiles, checksum))
+            return false;
+
+        contents = formatBinaryAllocation(students, staff, checksum, score);
+        return true;
+    }
+
+    std::sort(
+        students.begin(),
+        students.end(),
+        [](const Student& a, const Student& b) { return a.id < b.id; });
+
+    std::ostringstream out;
+    for (const auto& s : students) {
+        out << s.id << ' ' << s.assignedProject << ' ' << s.assignedSupervisor << '\n';
+    }
+    out << score << '\n';
+    contents = out.str();
+    return true;
+}
+
+void writeOutput(
+    const std::string& outFile,
+    const std::string& contents,
+    bool binary)
+{
+    std::ofstream out(outFile, binary ? std::ios::binary : std::ios::out);
+    if (!out) {
+        throw std::runtime_error("Failed to open output file: " + outFile);
+    }
+    out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Staff.h"
+#include "Student.h"
+
+// The allocation file as GenAlloc writes it. Text is one "studentId project
+// supervisor" line per student sorted by id (students is sorted in place)
+// then the score. Binary is formatBinaryAllocation in students.txt order,
+// inputFiles are the staff, projects and students files for its checksum.
+// False if those can't be read.
+bool formatAllocation(
+    std::vector<Student>& students,
+    const std::unordered_map<std::string, Staff>& staff,
+    const std::vector<std::string>& inputFiles,
+    int score,
+    bool binary,
+    std::string& contents
+);
+
+// Throws if the file can't be opened
+void writeOutput(
+    const std::string& outFile,
+    const std::string& contents,
+    bool binary
+);
@@ -0,0 +1,127 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of threads to spread work over, at least one
+inline unsigned workerCount()
+{
+    const unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+// Calls fn(begin, end) on contiguous chunks of [0, count), one chunk per
+// thread. Chunks are never smaller than grain so small ranges run inline.
+template <typename Fn>
+void parallelFor(std::size_t count, std::size_t grain, Fn fn)
+{
+    const std::size_t maxChunks = std::max<std::size_t>(1, count / std::max<std::size_t>(1, grain));
+    const std::size_t chunks = std::min<std::size_t>(workerCount(), maxChunks);
+
+    if (chunks <= 1) {
+        if (count > 0) fn(std::size_t{ 0 }, count);
+        return;
+    }
+
+    const std::size_t step = (count + chunks - 1) / chunks;
+
+    std::vector<std::thread> threads;
+    threads.reserve(chunks - 1);
+    for (std::size_t c = 1; c < chunks; ++c) {
+        const std::size_t begin = std::min(count, c * step);
+        const std::size_t end = std::min(count, begin + step);
+        threads.emplace_back([=, &fn] { fn(begin, end); });
+    }
+
+    fn(std::size_t{ 0 }, std::min(count, step));
+
+    for (auto& t : threads) t.join();
+}
+
+// Calls fn(i) for every i in [0, count). Threads take the next index as they
+// finish so uneven items still keep every thread busy.
+template <typename Fn>
+void parallelForEach(std::size_t count, Fn fn)
+{
+    const std::size_t threadCount = std::min<std::size_t>(workerCount(), count);
+    if (threadCount <= 1) {
+        for (std::size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    std::atomic<std::size_t> next{ 0 };
+    auto worker = [&] {
+        for (std::size_t i = next++; i < count; i = next++) fn(i);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (std::size_t t = 1; t < threadCount; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+
+    for (auto& t : threads) t.join();
+}
+
+// Calls fn(i) for every i in [0, count) on a work stealing pool. Items are
+// dealt round robin into one queue per thread, so put the biggest first to
+// spread them out. A thread works from the front of its own queue and when
+// it runs dry steals from the back of the others'.
+template <typename Fn>
+void parallelForEachStealing(std::size_t count, Fn fn)
+{
+    const std::size_t threadCount = std::min<std::size_t>(workerCount(), count);
+    if (threadCount <= 1) {
+        for (std::size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::size_t> items;
+    };
+
+    std::vector<Queue> queues(threadCount);
+    for (std::size_t i = 0; i < count; ++i) {
+        queues[i % threadCount].items.push_back(i);
+    }
+
+    // nothing is added once running, so finding every queue empty means done
+    auto take = [&](std::size_t self, std::size_t& item) {
+        for (std::size_t k = 0; k < threadCount; ++k) {
+            Queue& q = queues[(self + k) % threadCount];
+            std::lock_guard<std::mutex> guard(q.lock);
+            if (q.items.empty()) continue;
+
+            if (k == 0) {
+                item = q.items.front();
+                q.items.pop_front();
+            }
+            else {
+                item = q.items.back();
+                q.items.pop_back();
+            }
+            return true;
+        }
+        return false;
+    };
+
+    auto worker = [&](std::size_t self) {
+        std::size_t item;
+        while (take(self, item)) fn(item);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (std::size_t t = 1; t < threadCount; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+
+    for (auto& t : threads) t.join();
+}
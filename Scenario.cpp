@@ -0,0 +1,201 @@
+#include "Scenario.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Allocator.h"
+#include "Checker.h"
+#include "Parallel.h"
+#include "Score.h"
+#include "Stabilize.h"
+
+namespace
+{
+    // The allocator writes assignments and counters into every student,
+    // project and supervisor, so a scenario gets a private copy of the base
+    // with only its own changes applied on top
+    struct Instance {
+        std::vector<Student> students;
+        std::unordered_map<int, Project> projects;
+        std::unordered_map<std::string, Staff> staff;
+    };
+
+    Instance Materialise(
+        const std::vector<Student>& students,
+        const std::unordered_map<int, Project>& projects,
+        const std::unordered_map<std::string, Staff>& staff,
+        const Scenario* scenario)
+    {
+        Instance inst{ students, projects, staff };
+        if (!scenario)
+            return inst;
+
+        for (const auto& kv : scenario->loads) {
+            auto it = inst.staff.find(kv.first);
+            if (it != inst.staff.end()) it->second.load = kv.second;
+        }
+
+        for (const auto& kv : scenario->capacities) {
+            auto it = inst.projects.find(kv.first);
+            if (it != inst.projects.end()) it->second.multiplicity = kv.second;
+        }
+
+        for (int pid : scenario->withdrawn) {
+            inst.projects.erase(pid);
+        }
+
+        if (!scenario->preferences.empty()) {
+            for (auto& s : inst.students) {
+                auto it = scenario->preferences.find(s.id);
+                if (it != scenario->preferences.end()) s.choices = it->second;
+            }
+        }
+        return inst;
+    }
+
+    ScenarioResult Run(Instance& inst, const std::string& name, bool verify)
+    {
+        allocate(inst.students, inst.projects, inst.staff);
+        stabilize(inst.students, inst.projects, inst.staff);
+
+        ScenarioResult result;
+        result.name = name;
+        result.score = computeScore(inst.students, inst.projects, inst.staff);
+        if (verify) result.valid = checkAllocation(inst.students, inst.projects, inst.staff);
+        return result;
+    }
+
+    std::string Describe(const Student& s)
+    {
+        return std::to_string(s.assignedProject) + ' ' + s.assignedSupervisor;
+    }
+}
+
+void parseScenarios(
+    const std::string& filename,
+    std::vector<Scenario>& scenarios)
+{
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to open scenarios file\n";
+        return;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+
+        std::string kind;
+        if (!(iss >> kind)) continue;
+
+        if (kind == "scenario") {
+            Scenario sc;
+            iss >> sc.name;
+            scenarios.push_back(sc);
+            continue;
+        }
+
+        if (scenarios.empty()) {
+            std::cerr << "Scenario change before any scenario line: " << line << '\n';
+            continue;
+        }
+
+        Scenario& sc = scenarios.back();
+        bool ok = true;
+
+        if (kind == "load") {
+            std::string sid;
+            int load;
+            ok = static_cast<bool>(iss >> sid >> load);
+            if (ok) sc.loads[sid] = load;
+        }
+        else if (kind == "capacity") {
+            int pid, multiplicity;
+            ok = static_cast<bool>(iss >> pid >> multiplicity);
+            if (ok) sc.capacities[pid] = multiplicity;
+        }
+        else if (kind == "withdraw") {
+            int pid;
+            ok = static_cast<bool>(iss >> pid);
+            if (ok) sc.withdrawn.insert(pid);
+        }
+        else if (kind == "prefs") {
+            std::string sid;
+            ok = static_cast<bool>(iss >> sid);
+
+            std::vector<int> choices;
+            int choice;
+            while (ok && iss >> choice) {
+                choices.push_back(choice);
+            }
+            if (ok) sc.preferences[sid] = choices;
+        }
+        else {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "Ignoring bad scenario line: " << line << '\n';
+        }
+    }
+}
+
+std::vector<ScenarioResult> runScenarios(
+    const std::vector<Student>& students,
+    const std::unordered_map<int, Project>& projects,
+    const std::unordered_map<std::string, Staff>& staff,
+    const std::vector<Scenario>& scenarios,
+    bool verify)
+{
+    std::vector<ScenarioResult> results(scenarios.size() + 1);
+
+    Instance base = Materialise(students, projects, staff, nullptr);
+    results[0] = Run(base, "baseline", verify);
+
+    parallelForEach(scenarios.size(), [&](std::size_t n) {
+        Instance inst = Materialise(students, projects, staff, &scenarios[n]);
+        ScenarioResult result = Run(inst, scenarios[n].name, verify);
+
+        // student order is the same in every copy
+        for (std::size_t i = 0; i < inst.students.size(); ++i) {
+            const Student& before = base.students[i];
+            const Student& after = inst.students[i];
+            if (before.assignedProject == after.assignedProject &&
+                before.assignedSupervisor == after.assignedSupervisor)
+                continue;
+
+            result.changes.push_back(after.id + ' ' + Describe(before) + " -> " + Describe(after));
+        }
+
+        results[n + 1] = std::move(result);
+    });
+
+    return results;
+}
+
+std::string formatScenarioReport(
+    const std::vector<ScenarioResult>& results,
+    bool verify)
+{
+    std::ostringstream out;
+    const int baseScore = results.empty() ? 0 : results[0].score;
+
+    for (std::size_t n = 0; n < results.size(); ++n) {
+        const ScenarioResult& r = results[n];
+        const int delta = r.score - baseScore;
+
+        out << r.name << " score " << r.score;
+        if (n > 0) {
+            out << " change " << (delta >= 0 ? "+" : "") << delta
+                << " moved " << r.changes.size();
+        }
+        if (verify) out << (r.valid ? " VALID" : " INVALID");
+        out << '\n';
+
+        for (const auto& change : r.changes) {
+            out << "  " << change << '\n';
+        }
+    }
+    return out.str();
+}
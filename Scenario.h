@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Staff.h"
+#include "Project.h"
+#include "Student.h"
+
+// Changes to the base instance for one what-if run, only what differs is
+// stored
+struct Scenario {
+    std::string name;
+    std::unordered_map<std::string, int> loads;
+    std::unordered_map<int, int> capacities;
+    std::unordered_set<int> withdrawn;
+    std::unordered_map<std::string, std::vector<int>> preferences;
+};
+
+struct ScenarioResult {
+    std::string name;
+    int score = 0;
+    bool valid = true;
+
+    // "studentId oldProject oldSupervisor -> newProject newSupervisor"
+    // for every student whose allocation differs from the baseline
+    std::vector<std::string> changes;
+};
+
+// Scenario file, one scenario per "scenario name" line followed by any of
+//   load staffId n
+//   capacity projectId n
+//   withdraw projectId
+//   prefs studentId choice1 choice2 ...
+void parseScenarios(
+    const std::string& filename,
+    std::vector<Scenario>& scenarios
+);
+
+// Allocates and scores the base instance and every scenario. The base data
+// is shared read only, each scenario works on its own copy with its changes
+// applied and the scenarios run in parallel. The first result is the
+// baseline. With verify each result is also checked against the rules.
+std::vector<ScenarioResult> runScenarios(
+    const std::vector<Student>& students,
+    const std::unordered_map<int, Project>& projects,
+    const std::unordered_map<std::string, Staff>& staff,
+    const std::vector<Scenario>& scenarios,
+    bool verify
+);
+
+std::string formatScenarioReport(
+    const std::vector<ScenarioResult>& results,
+    bool verify
+);
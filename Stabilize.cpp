@@ -0,0 +1,372 @@
+#include "Stabilize.h"
+#include "Checker.h"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // students grouped by how their supervisor rates their project
+    using ByCategory = std::array<std::set<int>, 3>;
+
+    // Indexes over the allocation so each rule only looks at the students
+    // and projects that could take part in a violation
+    class Stabilizer {
+    public:
+        Stabilizer(
+            std::vector<Student>& students,
+            std::unordered_map<int, Project>& projects,
+            const std::unordered_map<std::string, Staff>& staff)
+            : students(students), projects(projects), staff(staff)
+        {
+            for (const auto& kv : staff) {
+                for (const auto& subject : kv.second.expertise) {
+                    staffBySubject[subject].push_back(kv.first);
+                }
+            }
+
+            for (auto& kv : projects) {
+                kv.second.assigned = 0;
+            }
+
+            position.assign(students.size(), -1);
+            queued.assign(students.size(), false);
+
+            for (int i = 0; i < static_cast<int>(students.size()); ++i) {
+                const Student& s = students[i];
+                for (int pid : s.choices) {
+                    if (projects.count(pid)) choosers[pid].push_back(i);
+                }
+
+                auto pit = projects.find(s.assignedProject);
+                if (pit == projects.end())
+                    continue;
+
+                pit->second.assigned++;
+                Hold(i, s.assignedProject);
+                Track(i);
+            }
+
+            for (const auto& kv : projects) {
+                if (IsAvailable(kv.first)) Open(kv.second);
+            }
+        }
+
+        void run()
+        {
+            for (int i = 0; i < static_cast<int>(students.size()); ++i) {
+                Push(i);
+            }
+
+            // every repair raises the students' ranks, or the supervisors'
+            // categories without lowering the students', so this ends
+            while (!work.empty()) {
+                const int i = work.front();
+                work.pop_front();
+                queued[i] = false;
+
+                if (!Active(i))
+                    continue;
+
+                if (FixRule1(i) || FixRule2(i) || FixRule3(i) || FixRule4(i))
+                    Push(i);
+            }
+        }
+
+    private:
+        std::vector<Student>& students;
+        std::unordered_map<int, Project>& projects;
+        const std::unordered_map<std::string, Staff>& staff;
+
+        std::unordered_map<std::string, std::vector<std::string>> staffBySubject;
+        std::unordered_map<int, std::vector<int>> choosers;
+
+        // students on each project, position is where in the list
+        std::unordered_map<int, std::vector<int>> holders;
+        std::vector<int> position;
+
+        // projects with room, by proposer and by subject
+        std::unordered_map<std::string, std::set<int>> openByProposer;
+        std::unordered_map<std::string, std::set<int>> openBySubject;
+
+        // students of each supervisor, and the subset on a project they
+        // didn't choose which are the only ones rule 3 applies to
+        std::unordered_map<std::string, ByCategory> supervisees;
+        std::unordered_map<std::string, ByCategory> unchosen;
+
+        std::deque<int> work;
+        std::vector<bool> queued;
+
+        void Push(int i)
+        {
+            if (queued[i]) return;
+            queued[i] = true;
+            work.push_back(i);
+        }
+
+        bool Active(int i) const
+        {
+            const Student& s = students[i];
+            return projects.count(s.assignedProject) &&
+                staff.count(s.assignedSupervisor);
+        }
+
+        bool IsAvailable(int pid) const
+        {
+            auto pit = projects.find(pid);
+            return pit != projects.end() && pit->second.assigned < pit->second.multiplicity;
+        }
+
+        int Category(int i) const
+        {
+            const Student& s = students[i];
+            return supervisorCategoryForProject(staff.at(s.assignedSupervisor), projects.at(s.assignedProject));
+        }
+
+        bool Unchosen(int i) const
+        {
+            return studentRankForProject(students[i], students[i].assignedProject) == kNoRank;
+        }
+
+        void Open(const Project& p)
+        {
+            openByProposer[p.proposer].insert(p.id);
+            openBySubject[p.subject].insert(p.id);
+        }
+
+        void Close(const Project& p)
+        {
+            openByProposer[p.proposer].erase(p.id);
+            openBySubject[p.subject].erase(p.id);
+        }
+
+        void Track(int i)
+        {
+            if (!Active(i)) return;
+            const int cat = Category(i);
+            supervisees[students[i].assignedSupervisor][cat].insert(i);
+            if (Unchosen(i)) unchosen[students[i].assignedSupervisor][cat].insert(i);
+        }
+
+        void Untrack(int i)
+        {
+            if (!Active(i)) return;
+            const int cat = Category(i);
+            supervisees[students[i].assignedSupervisor][cat].erase(i);
+            unchosen[students[i].assignedSupervisor][cat].erase(i);
+        }
+
+        void Unhold(int i, int pid)
+        {
+            std::vector<int>& h = holders[pid];
+            const int last = h.back();
+            h[position[i]] = last;
+            position[last] = position[i];
+            h.pop_back();
+        }
+
+        void Hold(int i, int pid)
+        {
+            std::vector<int>& h = holders[pid];
+            position[i] = static_cast<int>(h.size());
+            h.push_back(i);
+            students[i].assignedProject = pid;
+        }
+
+        void PushAll(const std::set<int>& group, int except)
+        {
+            for (int j : group) {
+                if (j != except) Push(j);
+            }
+        }
+
+        // Moves a student into a project with room. The seat left behind can
+        // only trip rule 1 for students who chose it, or rule 3 for students
+        // on unchosen projects whose supervisor would rather have it.
+        void Move(int i, int to)
+        {
+            const int from = students[i].assignedProject;
+            Project& pFrom = projects.at(from);
+            Project& pTo = projects.at(to);
+
+            Untrack(i);
+            Unhold(i, from);
+            Hold(i, to);
+            Track(i);
+
+            if (pFrom.assigned-- == pFrom.multiplicity) Open(pFrom);
+            if (++pTo.assigned == pTo.multiplicity) Close(pTo);
+
+            for (int j : choosers[from]) {
+                if (j != i) Push(j);
+            }
+
+            auto uit = unchosen.find(pFrom.proposer);
+            if (uit != unchosen.end()) {
+                PushAll(uit->second[1], i);
+                PushAll(uit->second[2], i);
+            }
+
+            auto sit = staffBySubject.find(pFrom.subject);
+            if (sit == staffBySubject.end())
+                return;
+
+            for (const auto& sid : sit->second) {
+                if (sid == pFrom.proposer) continue;
+                uit = unchosen.find(sid);
+                if (uit != unchosen.end()) PushAll(uit->second[2], i);
+            }
+        }
+
+        // Rule 1: a project the student ranked higher still has room
+        bool FixRule1(int i)
+        {
+            const Student& s = students[i];
+            const int curRank = studentRankForProject(s, s.assignedProject);
+
+            for (int r = 0; r < static_cast<int>(s.choices.size()) && r < curRank; ++r) {
+                if (IsAvailable(s.choices[r])) {
+                    Move(i, s.choices[r]);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Rule 2: someone on a project this student ranked higher would
+        // rather have this student's project
+        bool FixRule2(int i)
+        {
+            const Student& s = students[i];
+            const int pid = s.assignedProject;
+            const int curRank = studentRankForProject(s, pid);
+
+            for (int r = 0; r < static_cast<int>(s.choices.size()) && r < curRank; ++r) {
+                const int other = s.choices[r];
+                if (other == pid) continue;
+
+                auto hit = holders.find(other);
+                if (hit == holders.end()) continue;
+
+                for (int j : hit->second) {
+                    if (!Active(j)) continue;
+
+                    const Student& t = students[j];
+                    const int theirRank = studentRankForProject(t, pid);
+                    if (theirRank == kNoRank || theirRank >= studentRankForProject(t, other))
+                        continue;
+
+                    Untrack(i);
+                    Untrack(j);
+                    Unhold(i, pid);
+                    Unhold(j, other);
+                    Hold(i, other);
+                    Hold(j, pid);
+                    Track(i);
+                    Track(j);
+                    Push(j);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Rule 3: the student didn't choose their project and their
+        // supervisor would rather supervise one that still has room
+        bool FixRule3(int i)
+        {
+            if (!Unchosen(i))
+                return false;
+
+            const Staff& st = staff.at(students[i].assignedSupervisor);
+            const int cur = Category(i);
+
+            if (cur > 0) {
+                auto it = openByProposer.find(st.id);
+                if (it != openByProposer.end() && !it->second.empty()) {
+                    Move(i, *it->second.begin());
+                    return true;
+                }
+            }
+
+            if (cur > 1) {
+                for (const auto& subject : st.expertise) {
+                    auto it = openBySubject.find(subject);
+                    if (it != openBySubject.end() && !it->second.empty()) {
+                        Move(i, *it->second.begin());
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // looks through one supervisor's students in the given category for
+        // one whose supervisor would swap with this student's
+        bool TrySupervisorSwap(int i, const std::string& sid, int category)
+        {
+            auto it = supervisees.find(sid);
+            if (it == supervisees.end())
+                return false;
+
+            Student& a = students[i];
+            const Staff& supA = staff.at(a.assignedSupervisor);
+            const int curA = Category(i);
+
+            for (int j : it->second[category]) {
+                Student& b = students[j];
+                if (supervisorCategoryForProject(supA, projects.at(b.assignedProject)) >= curA)
+                    continue;
+
+                Untrack(i);
+                Untrack(j);
+                std::swap(a.assignedSupervisor, b.assignedSupervisor);
+                Track(i);
+                Track(j);
+                Push(j);
+                return true;
+            }
+            return false;
+        }
+
+        // Rule 4: this student's supervisor and another student's supervisor
+        // would both rather have each other's student. The other supervisor
+        // must be the proposer of this student's project, or have it in their
+        // expertise while their own student is on neither.
+        bool FixRule4(int i)
+        {
+            const Student& s = students[i];
+            if (Category(i) == 0)
+                return false;
+
+            const Project& p = projects.at(s.assignedProject);
+
+            if (p.proposer != s.assignedSupervisor && staff.count(p.proposer)) {
+                if (TrySupervisorSwap(i, p.proposer, 1)) return true;
+                if (TrySupervisorSwap(i, p.proposer, 2)) return true;
+            }
+
+            auto sit = staffBySubject.find(p.subject);
+            if (sit == staffBySubject.end())
+                return false;
+
+            for (const auto& sid : sit->second) {
+                if (sid == p.proposer || sid == s.assignedSupervisor) continue;
+                if (TrySupervisorSwap(i, sid, 2)) return true;
+            }
+            return false;
+        }
+    };
+}
+
+void stabilize(
+    std::vector<Student>& students,
+    std::unordered_map<int, Project>& projects,
+    const std::unordered_map<std::string, Staff>& staff)
+{
+    Stabilizer(students, projects, staff).run();
+}
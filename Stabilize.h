@@ -0,0 +1,18 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "Staff.h"
+#include "Project.h"
+#include "Student.h"
+
+// Repairs an allocation until none of CheckAlloc's stability rules fail.
+//
+// Students are moved into free projects they or their supervisor prefer and
+// pairs of students swap projects or supervisors when both sides gain.
+// Capacities and loads are never exceeded. Students left without a project
+// or supervisor are ignored.
+void stabilize(
+    std::vector<Student>& students,
+    std::unordered_map<int, Project>& projects,
+    const std::unordered_map<std::string, Staff>& staff
+);
@@ -1,13 +1,19 @@
 #include <algorithm>
-#include <fstream>
+#include <chrono>
 #include <iostream>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "Allocator.h"
+#include "Batch.h"
+#include "Cache.h"
+#include "Checker.h"
+#include "Output.h"
 #include "Parser.h"
+#include "Scenario.h"
 #include "Score.h"
+#include "Stabilize.h"
 
 #include "Project.h"
 #include "Staff.h"
@@ -15,39 +21,133 @@
 
 namespace
 {
+    // bump when a change to the allocator changes its output
+    const char* const kEngine = "GenAlloc/2";
+
+    struct Options {
+        std::vector<std::string> files;
+        std::string cacheDir;
+        std::string scenariosFile;
+        bool batch = false;
+        bool binary = false;
+        bool verify = false;
+    };
+
     void PrintUsage(std::ostream& os)
     {
-        os << "Usage: ./GenAlloc staff.txt projects.txt students.txt alloc.txt\n";
+        os << "Usage: ./GenAlloc staff.txt projects.txt students.txt alloc.txt [--format text|binary] [--cache dir] [--verify]\n"
+           << "       ./GenAlloc staff.txt projects.txt students.txt report.txt --scenarios scenarios.txt [--cache dir] [--verify]\n"
+           << "       ./GenAlloc --batch manifest.txt summary.txt [--format text|binary] [--verify]\n";
     }
 
-    void WriteOutput(
-        const std::string& outFile,
-        const std::vector<Student>& students,
-        int score)
+    bool ParseArgs(int argc, char* argv[], Options& opts)
     {
-        std::ofstream out(outFile);
-        if (!out) {
-            throw std::runtime_error("Failed to open output file: " + outFile);
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--cache" || arg == "--scenarios") {
+                if (++i == argc) return false;
+                (arg == "--cache" ? opts.cacheDir : opts.scenariosFile) = argv[i];
+            }
+            else if (arg == "--format") {
+                if (++i == argc) return false;
+                const std::string format = argv[i];
+                if (format != "text" && format != "binary") return false;
+                opts.binary = format == "binary";
+            }
+            else if (arg == "--verify") {
+                opts.verify = true;
+            }
+            else if (arg == "--batch") {
+                opts.batch = true;
+            }
+            else {
+                opts.files.push_back(arg);
+            }
         }
 
-        for (const auto& s : students) {
-            out << s.id << ' ' << s.assignedProject << ' ' << s.assignedSupervisor << '\n';
+        // batch instances don't go through the cache or scenarios
+        if (opts.batch)
+            return opts.files.size() == 2 && opts.cacheDir.empty() && opts.scenariosFile.empty();
+        return opts.files.size() == 4;
+    }
+
+    int RunBatch(const Options& opts)
+    {
+        // a missing or empty manifest is a mistake, not a batch with
+        // nothing to do
+        std::vector<std::string> dirs;
+        if (!parseManifest(opts.files[0], dirs))
+            return 1;
+        if (dirs.empty()) {
+            std::cerr << "No instance directories in manifest file\n";
+            return 1;
         }
-        out << score << '\n';
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto results = runBatch(dirs, opts.binary, opts.verify);
+        const double wallMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        try {
+            writeOutput(opts.files[1], formatBatchSummary(results, wallMs, opts.verify), false);
+        }
+        catch (const std::exception& ex) {
+            std::cerr << ex.what() << '\n';
+            return 1;
+        }
+
+        const bool allOk = std::all_of(results.begin(), results.end(),
+            [](const BatchResult& r) { return r.ok; });
+        return allOk ? 0 : 1;
     }
+
 }
 
 int main(int argc, char* argv[])
 {
-    if (argc != 5) {
+    Options opts;
+    if (!ParseArgs(argc, argv, opts)) {
         PrintUsage(std::cerr);
         return 1;
     }
 
-    const std::string staffFile = argv[1];
-    const std::string projectsFile = argv[2];
-    const std::string studentsFile = argv[3];
-    const std::string outFile = argv[4];
+    if (opts.batch)
+        return RunBatch(opts);
+
+    const std::string& staffFile = opts.files[0];
+    const std::string& projectsFile = opts.files[1];
+    const std::string& studentsFile = opts.files[2];
+    const std::string& outFile = opts.files[3];
+
+    // the scenario report is always text
+    if (!opts.scenariosFile.empty()) opts.binary = false;
+
+    // identical inputs give an identical allocation, reuse it if we have it
+    std::string key;
+    if (!opts.cacheDir.empty()) {
+        // verified runs keep their own entries so a hit was checked too
+        std::vector<std::string> options;
+        std::vector<std::string> inputs = { staffFile, projectsFile, studentsFile };
+        if (opts.verify) options.push_back("verify");
+        if (opts.binary) options.push_back("binary");
+        if (!opts.scenariosFile.empty()) {
+            options.push_back("scenarios");
+            inputs.push_back(opts.scenariosFile);
+        }
+        key = cacheKey(kEngine, options, inputs);
+
+        std::string cached;
+        if (cacheLookup(opts.cacheDir, key, cached)) {
+            try {
+                writeOutput(outFile, cached, opts.binary);
+            }
+            catch (const std::exception& ex) {
+                std::cerr << ex.what() << '\n';
+                return 1;
+            }
+            return 0;
+        }
+    }
 
     std::unordered_map<std::string, Staff> staff;
     std::unordered_map<int, Project> projects;
@@ -57,22 +157,41 @@ int main(int argc, char* argv[])
     parseProjects(projectsFile, projects);
     parseStudents(studentsFile, students);
 
-    allocate(students, projects, staff);
+    std::string text;
+    if (!opts.scenariosFile.empty()) {
+        std::vector<Scenario> scenarios;
+        parseScenarios(opts.scenariosFile, scenarios);
+
+        const auto results = runScenarios(students, projects, staff, scenarios, opts.verify);
+        text = formatScenarioReport(results, opts.verify);
+    }
+    else {
+        allocate(students, projects, staff);
+        stabilize(students, projects, staff);
+
+        const int score = computeScore(students, projects, staff);
 
-    const int score = computeScore(students, projects, staff);
+        // same rules as CheckAlloc, without writing and re-reading the files
+        if (opts.verify && !checkAllocation(students, projects, staff)) {
+            std::cerr << "Allocation failed verification, not written\n";
+            return 1;
+        }
 
-    std::sort(
-        students.begin(),
-        students.end(),
-        [](const Student& a, const Student& b) { return a.id < b.id; });
+        if (!formatAllocation(students, staff, { staffFile, projectsFile, studentsFile }, score, opts.binary, text)) {
+            std::cerr << "Failed to read input files for checksum\n";
+            return 1;
+        }
+    }
 
     try {
-        WriteOutput(outFile, students, score);
+        writeOutput(outFile, text, opts.binary);
     }
     catch (const std::exception& ex) {
         std::cerr << ex.what() << '\n';
         return 1;
     }
 
+    cacheStore(opts.cacheDir, key, text);
+
     return 0;
 }
\ No newline at end of file